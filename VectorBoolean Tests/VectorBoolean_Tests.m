@@ -8,6 +8,13 @@
 
 #import <XCTest/XCTest.h>
 #import "NSBezierPath+Boolean.h"
+#import "FBBezierGraph.h"
+#import "FBBezierContour.h"
+#import "FBBezierCurve.h"
+#import "FBContourEdge.h"
+#import "Geometry.h"
+
+static const CGFloat FBSimplifyTolerance = 1e-5;
 
 @interface VectorBoolean_Tests : XCTestCase
 
@@ -69,4 +76,257 @@
     
 }
 
+- (void)assertCurve:(FBBezierCurve *)curve matchesCurve:(FBBezierCurve *)expected{
+    XCTAssertTrue(FBArePointsCloseWithOptions(curve.endPoint1, expected.endPoint1, FBSimplifyTolerance), @"start should match");
+    XCTAssertTrue(FBArePointsCloseWithOptions(curve.controlPoint1, expected.controlPoint1, FBSimplifyTolerance), @"first control point should match");
+    XCTAssertTrue(FBArePointsCloseWithOptions(curve.controlPoint2, expected.controlPoint2, FBSimplifyTolerance), @"second control point should match");
+    XCTAssertTrue(FBArePointsCloseWithOptions(curve.endPoint2, expected.endPoint2, FBSimplifyTolerance), @"end should match");
+}
+
+- (void)assertRect:(NSRect)rect matchesRect:(NSRect)expected{
+    XCTAssertTrue(FBAreValuesCloseWithOptions(NSMinX(rect), NSMinX(expected), FBSimplifyTolerance)
+                  && FBAreValuesCloseWithOptions(NSMinY(rect), NSMinY(expected), FBSimplifyTolerance)
+                  && FBAreValuesCloseWithOptions(NSMaxX(rect), NSMaxX(expected), FBSimplifyTolerance)
+                  && FBAreValuesCloseWithOptions(NSMaxY(rect), NSMaxY(expected), FBSimplifyTolerance),
+                  @"%@ should match %@", NSStringFromRect(rect), NSStringFromRect(expected));
+}
+
+- (void)assertContourIsContinuous:(FBBezierContour *)contour{
+    // every edge has to start exactly where the previous one ended,
+    // including the first edge following the last one
+    FBContourEdge* previous = [contour.edges lastObject];
+    for (FBContourEdge* edge in contour.edges) {
+        XCTAssertTrue(NSEqualPoints(previous.curve.endPoint2, edge.curve.endPoint1), @"edges should meet without a gap");
+        previous = edge;
+    }
+}
+
+- (void)testSimplifyJoinsSplitEdges{
+    //
+    // build a 100x100 box whose bottom edge is made of
+    // two colinear lines plus a zero length line, and
+    // whose top edge is a curve split into two pieces
+    //
+    FBBezierCurve* top = [FBBezierCurve bezierCurveWithEndPoint1:NSMakePoint(100, 100)
+                                                   controlPoint1:NSMakePoint(70, 140)
+                                                   controlPoint2:NSMakePoint(30, 140)
+                                                       endPoint2:NSMakePoint(0, 100)];
+    FBBezierCurve* topLeft = nil;
+    FBBezierCurve* topRight = nil;
+    [top pointAtParameter:0.3 leftBezierCurve:&topLeft rightBezierCurve:&topRight];
+    
+    NSBezierPath* path = [NSBezierPath bezierPath];
+    [path moveToPoint:NSMakePoint(0, 0)];
+    [path lineToPoint:NSMakePoint(40, 0)];
+    [path lineToPoint:NSMakePoint(40.0000001, 0)];
+    [path lineToPoint:NSMakePoint(100, 0)];
+    [path lineToPoint:NSMakePoint(100, 100)];
+    [path curveToPoint:topLeft.endPoint2 controlPoint1:topLeft.controlPoint1 controlPoint2:topLeft.controlPoint2];
+    [path curveToPoint:topRight.endPoint2 controlPoint1:topRight.controlPoint1 controlPoint2:topRight.controlPoint2];
+    [path closePath];
+    
+    FBBezierGraph* graph = [FBBezierGraph bezierGraphWithBezierPath:path];
+    FBBezierGraph* simplified = [graph simplifiedBezierGraphWithTolerance:FBSimplifyTolerance];
+    
+    XCTAssertEqual([simplified.contours count], (NSUInteger)1, @"should keep the single contour");
+    FBBezierContour* contour = [simplified.contours objectAtIndex:0];
+    XCTAssertEqual([contour.edges count], (NSUInteger)4, @"bottom, right, top and left edges should remain");
+    [self assertRect:contour.bounds matchesRect:[[graph.contours objectAtIndex:0] bounds]];
+    [self assertCurve:[[contour.edges objectAtIndex:2] curve] matchesCurve:top];
+    [self assertContourIsContinuous:contour];
+    
+    // the right edge turns a corner, so it must never be merged with the bottom
+    FBBezierCurve* bottom = [FBBezierCurve bezierCurveWithLineStartPoint:NSMakePoint(0, 0) endPoint:NSMakePoint(100, 0)];
+    FBBezierCurve* right = [FBBezierCurve bezierCurveWithLineStartPoint:NSMakePoint(100, 0) endPoint:NSMakePoint(100, 100)];
+    XCTAssertNil([bottom curveJoinedWithCurve:right tolerance:FBSimplifyTolerance], @"corners can't be joined");
+    [self assertCurve:[topLeft curveJoinedWithCurve:topRight tolerance:FBSimplifyTolerance] matchesCurve:top];
+}
+
+- (void)testSimplifyRejoinsCurveSplitManyTimes{
+    //
+    // a curve split into four pieces should come back as
+    // the original curve, not drift a little per join
+    //
+    FBBezierCurve* top = [FBBezierCurve bezierCurveWithEndPoint1:NSMakePoint(100, 100)
+                                                   controlPoint1:NSMakePoint(70, 140)
+                                                   controlPoint2:NSMakePoint(30, 140)
+                                                       endPoint2:NSMakePoint(0, 100)];
+    FBBezierContour* contour = [[[FBBezierContour alloc] init] autorelease];
+    [contour addCurve:[FBBezierCurve bezierCurveWithLineStartPoint:NSMakePoint(0, 100) endPoint:NSMakePoint(100, 100)]];
+    [contour addCurve:[top subcurveWithRange:FBRangeMake(0.0, 0.1)]];
+    [contour addCurve:[top subcurveWithRange:FBRangeMake(0.1, 0.45)]];
+    [contour addCurve:[top subcurveWithRange:FBRangeMake(0.45, 0.8)]];
+    [contour addCurve:[top subcurveWithRange:FBRangeMake(0.8, 1.0)]];
+    
+    FBBezierContour* simplified = [contour simplifiedContourWithTolerance:FBSimplifyTolerance];
+    XCTAssertEqual([simplified.edges count], (NSUInteger)2, @"the pieces should be one curve again");
+    [self assertCurve:[[simplified.edges objectAtIndex:1] curve] matchesCurve:top];
+    [self assertContourIsContinuous:simplified];
+}
+
+- (void)testSimplifyJoinsLastEdgeWithFirst{
+    //
+    // start the contour in the middle of a split curve,
+    // so its two halves are the last and first edges
+    //
+    FBBezierCurve* top = [FBBezierCurve bezierCurveWithEndPoint1:NSMakePoint(100, 100)
+                                                   controlPoint1:NSMakePoint(70, 140)
+                                                   controlPoint2:NSMakePoint(30, 140)
+                                                       endPoint2:NSMakePoint(0, 100)];
+    FBBezierCurve* topLeft = nil;
+    FBBezierCurve* topRight = nil;
+    [top pointAtParameter:0.6 leftBezierCurve:&topLeft rightBezierCurve:&topRight];
+    
+    NSBezierPath* path = [NSBezierPath bezierPath];
+    [path moveToPoint:topRight.endPoint1];
+    [path curveToPoint:topRight.endPoint2 controlPoint1:topRight.controlPoint1 controlPoint2:topRight.controlPoint2];
+    [path lineToPoint:NSMakePoint(0, 0)];
+    [path lineToPoint:NSMakePoint(100, 0)];
+    [path lineToPoint:NSMakePoint(100, 100)];
+    [path curveToPoint:topLeft.endPoint2 controlPoint1:topLeft.controlPoint1 controlPoint2:topLeft.controlPoint2];
+    [path closePath];
+    
+    FBBezierGraph* graph = [FBBezierGraph bezierGraphWithBezierPath:path];
+    FBBezierContour* contour = [[[graph simplifiedBezierGraphWithTolerance:FBSimplifyTolerance] contours] objectAtIndex:0];
+    XCTAssertEqual([contour.edges count], (NSUInteger)4, @"the halves should wrap around and join");
+    [self assertCurve:[[contour.edges lastObject] curve] matchesCurve:top];
+    [self assertContourIsContinuous:contour];
+}
+
+- (void)testSimplifyDoesNotMergeSpike{
+    //
+    // the bottom edge runs out to 100 and then doubles
+    // back to 50, which isn't the same as a line to 50
+    //
+    FBBezierCurve* outward = [FBBezierCurve bezierCurveWithLineStartPoint:NSMakePoint(0, 0) endPoint:NSMakePoint(100, 0)];
+    FBBezierCurve* back = [FBBezierCurve bezierCurveWithLineStartPoint:NSMakePoint(100, 0) endPoint:NSMakePoint(50, 0)];
+    XCTAssertNil([outward curveJoinedWithCurve:back tolerance:FBSimplifyTolerance], @"anti-parallel lines can't be joined");
+    
+    NSBezierPath* path = [NSBezierPath bezierPath];
+    [path moveToPoint:NSMakePoint(0, 0)];
+    [path lineToPoint:NSMakePoint(100, 0)];
+    [path lineToPoint:NSMakePoint(50, 0)];
+    [path lineToPoint:NSMakePoint(50, 50)];
+    [path closePath];
+    
+    FBBezierGraph* graph = [FBBezierGraph bezierGraphWithBezierPath:path];
+    FBBezierContour* contour = [[[graph simplifiedBezierGraphWithTolerance:FBSimplifyTolerance] contours] objectAtIndex:0];
+    XCTAssertEqual([contour.edges count], (NSUInteger)4, @"the spike should be kept");
+}
+
+- (void)testSimplifyDoesNotJoinUnrelatedCubics{
+    //
+    // these two curves meet with matching tangents, but
+    // aren't two halves of any one curve
+    //
+    FBBezierCurve* first = [FBBezierCurve bezierCurveWithEndPoint1:NSMakePoint(0, 0)
+                                                     controlPoint1:NSMakePoint(10, 10)
+                                                     controlPoint2:NSMakePoint(20, 10)
+                                                         endPoint2:NSMakePoint(30, 0)];
+    FBBezierCurve* second = [FBBezierCurve bezierCurveWithEndPoint1:NSMakePoint(30, 0)
+                                                      controlPoint1:NSMakePoint(40, -10)
+                                                      controlPoint2:NSMakePoint(60, -10)
+                                                          endPoint2:NSMakePoint(90, 0)];
+    XCTAssertNil([first curveJoinedWithCurve:second tolerance:FBSimplifyTolerance], @"unrelated curves can't be joined");
+}
+
+- (void)testSimplifyDropsDegenerateCornerWithoutGap{
+    //
+    // a tiny edge at the bottom right corner gets dropped,
+    // and the right edge has to be moved to close the gap
+    //
+    NSBezierPath* path = [NSBezierPath bezierPath];
+    [path moveToPoint:NSMakePoint(0, 0)];
+    [path lineToPoint:NSMakePoint(100, 0)];
+    [path lineToPoint:NSMakePoint(100, 0.000001)];
+    [path lineToPoint:NSMakePoint(100, 100)];
+    [path lineToPoint:NSMakePoint(0, 100)];
+    [path closePath];
+    
+    FBBezierGraph* graph = [FBBezierGraph bezierGraphWithBezierPath:path];
+    FBBezierContour* contour = [[[graph simplifiedBezierGraphWithTolerance:FBSimplifyTolerance] contours] objectAtIndex:0];
+    XCTAssertEqual([contour.edges count], (NSUInteger)4, @"the degenerate edge should be dropped");
+    [self assertContourIsContinuous:contour];
+    [self assertRect:contour.bounds matchesRect:NSMakeRect(0, 0, 100, 100)];
+}
+
+- (void)testSimplifyDropsChainOfShortEdgesWithoutGap{
+    //
+    // three edges at the corner, each a bit shorter than
+    // the tolerance. Dropped one at a time they'd leave a
+    // gap of nearly three times the tolerance
+    //
+    CGFloat step = 0.9 * FBSimplifyTolerance;
+    NSBezierPath* path = [NSBezierPath bezierPath];
+    [path moveToPoint:NSMakePoint(0, 0)];
+    [path lineToPoint:NSMakePoint(100, 0)];
+    [path lineToPoint:NSMakePoint(100, step)];
+    [path lineToPoint:NSMakePoint(100, 2 * step)];
+    [path lineToPoint:NSMakePoint(100, 3 * step)];
+    [path lineToPoint:NSMakePoint(100, 100)];
+    [path lineToPoint:NSMakePoint(0, 100)];
+    [path closePath];
+    
+    FBBezierGraph* graph = [FBBezierGraph bezierGraphWithBezierPath:path];
+    FBBezierContour* contour = [[[graph simplifiedBezierGraphWithTolerance:FBSimplifyTolerance] contours] objectAtIndex:0];
+    XCTAssertEqual([contour.edges count], (NSUInteger)4, @"the short edges should fold into the right edge");
+    [self assertContourIsContinuous:contour];
+    [self assertRect:contour.bounds matchesRect:NSMakeRect(0, 0, 100, 100)];
+    for (FBContourEdge* edge in contour.edges)
+        XCTAssertTrue(FBDistanceBetweenPoints(edge.curve.endPoint1, edge.curve.endPoint2) > FBSimplifyTolerance, @"no short edges should remain");
+}
+
+- (void)testSimplifyKeepsGentleCurveWithinTolerance{
+    //
+    // a polyline sampled from a very shallow parabola. Each
+    // neighboring pair is nearly colinear, but the whole
+    // thing is far from a single line, so joins have to
+    // be checked against every vertex they swallow
+    //
+    NSBezierPath* path = [NSBezierPath bezierPath];
+    [path moveToPoint:NSMakePoint(0, 0)];
+    for (NSUInteger x = 3; x <= 3000; x += 3)
+        [path lineToPoint:NSMakePoint(x, 1e-8 * x * x)];
+    [path closePath];
+    
+    FBBezierGraph* graph = [FBBezierGraph bezierGraphWithBezierPath:path];
+    FBBezierContour* contour = [[[graph simplifiedBezierGraphWithTolerance:FBSimplifyTolerance] contours] objectAtIndex:0];
+    XCTAssertTrue([contour.edges count] > 2, @"the parabola can't collapse to a single line");
+    XCTAssertTrue([contour.edges count] < 1001, @"nearly colinear lines should still be merged");
+    
+    for (FBContourEdge* edge in contour.edges) {
+        NSPoint start = edge.curve.endPoint1;
+        NSPoint end = edge.curve.endPoint2;
+        if ( end.x <= start.x )
+            continue; // the closing line back to the start
+        for (NSUInteger x = 0; x <= 3000; x += 3) {
+            if ( x < start.x || x > end.x )
+                continue;
+            NSPoint vertex = NSMakePoint(x, 1e-8 * x * x);
+            XCTAssertTrue(FBDistancePointToLine(vertex, start, end) <= FBSimplifyTolerance, @"vertex %@ strays from the simplified edge", NSStringFromPoint(vertex));
+        }
+    }
+}
+
+- (void)testSimplifyKeepsChainedUnionEdgeCountsStable{
+    //
+    // keep unioning in a box that overlaps the right half
+    // of the result, sharing its top and bottom lines. The
+    // result is always a rectangle, so once simplified it
+    // should never grow past four edges
+    //
+    FBBezierGraph* result = [FBBezierGraph bezierGraphWithBezierPath:[NSBezierPath bezierPathWithRect:NSMakeRect(0, 0, 10, 10)]];
+    for (NSUInteger i = 1; i <= 8; i++) {
+        NSRect box = NSMakeRect(i * 5, 0, 10, 10);
+        FBBezierGraph* boxGraph = [FBBezierGraph bezierGraphWithBezierPath:[NSBezierPath bezierPathWithRect:box]];
+        result = [[result unionWithBezierGraph:boxGraph] simplifiedBezierGraphWithTolerance:FBSimplifyTolerance];
+        
+        XCTAssertEqual([result.contours count], (NSUInteger)1, @"the union should be one contour");
+        FBBezierContour* contour = [result.contours objectAtIndex:0];
+        XCTAssertEqual([contour.edges count], (NSUInteger)4, @"edge count shouldn't grow on pass %lu", (unsigned long)i);
+        [self assertContourIsContinuous:contour];
+        [self assertRect:contour.bounds matchesRect:NSMakeRect(0, 0, NSMaxX(box), 10)];
+    }
+}
+
 @end
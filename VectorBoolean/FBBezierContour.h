@@ -57,6 +57,7 @@ FBContourDirection;
 - (FBBezierContour*)	reversedContour;	// GPC: added
 - (FBContourDirection)	direction;
 - (FBBezierContour*)	contourMadeClockwiseIfNecessary;
+- (FBBezierContour*)	simplifiedContourWithTolerance:(CGFloat)tolerance;
 
 - (void) addOverlap:(FBContourOverlap *)overlap;
 - (void) removeAllOverlaps;
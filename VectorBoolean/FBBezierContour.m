@@ -26,6 +26,159 @@
 
 @end
 
+// FBCurveRun is a run of neighboring curves that have been joined into one while simplifying a
+//  contour. Checking each join against only the last curve lets error build up across the run,
+//  but rechecking every piece on every join would be quadratic. Instead, runs of lines keep the
+//  range of directions from their start that stays within tolerance of every vertex so far, and
+//  runs of curves check their first piece on each join, then every piece once when the run ends.
+@interface FBCurveRun : NSObject {
+    FBBezierCurve *_curve;
+    CGFloat _tolerance;
+    NSMutableArray *_pieces;
+    NSMutableArray *_parameters; // where each piece after the first started on the curve it was joined onto
+    FBRange _firstPieceRange;
+    NSPoint _referenceDirection;
+    CGFloat _minimumAngle;
+    CGFloat _maximumAngle;
+    CGFloat _farthestDistance;
+}
+
++ (id) curveRunWithCurve:(FBBezierCurve *)curve tolerance:(CGFloat)tolerance;
+- (id) initWithCurve:(FBBezierCurve *)curve tolerance:(CGFloat)tolerance;
+
+- (BOOL) appendCurve:(FBBezierCurve *)curve;
+- (NSArray *) simplifiedCurves;
+
+@end
+
+@interface FBCurveRun ()
+
+- (CGFloat) angleOfVertex:(NSPoint)vertex;
+- (void) constrainDirectionsWithVertex:(NSPoint)vertex;
+
+@end
+
+static FBBezierCurve *FBCurveWithStartPoint(FBBezierCurve *curve, NSPoint startPoint)
+{
+    // Move the start of the curve, dragging the first control point along with it
+    if ( NSEqualPoints(curve.endPoint1, startPoint) )
+        return curve;
+    if ( curve.isStraightLine )
+        return [FBBezierCurve bezierCurveWithLineStartPoint:startPoint endPoint:curve.endPoint2];
+    NSPoint offset = FBSubtractPoint(startPoint, curve.endPoint1);
+    return [FBBezierCurve bezierCurveWithEndPoint1:startPoint controlPoint1:FBAddPoint(curve.controlPoint1, offset) controlPoint2:curve.controlPoint2 endPoint2:curve.endPoint2];
+}
+
+@implementation FBCurveRun
+
++ (id) curveRunWithCurve:(FBBezierCurve *)curve tolerance:(CGFloat)tolerance
+{
+    return [[[FBCurveRun alloc] initWithCurve:curve tolerance:tolerance] autorelease];
+}
+
+- (id) initWithCurve:(FBBezierCurve *)curve tolerance:(CGFloat)tolerance
+{
+    self = [super init];
+    if ( self != nil ) {
+        _curve = [curve retain];
+        _tolerance = tolerance;
+        _pieces = [[NSMutableArray alloc] initWithObjects:curve, nil];
+        _parameters = [[NSMutableArray alloc] initWithCapacity:4];
+        _firstPieceRange = FBRangeMake(0.0, 1.0);
+        _referenceDirection = FBSubtractPoint(curve.endPoint2, curve.endPoint1);
+        _minimumAngle = -M_PI;
+        _maximumAngle = M_PI;
+        _farthestDistance = 0.0;
+        if ( curve.isStraightLine )
+            [self constrainDirectionsWithVertex:curve.endPoint2];
+    }
+    return self;
+}
+
+- (void) dealloc
+{
+    [_curve release];
+    [_pieces release];
+    [_parameters release];
+    [super dealloc];
+}
+
+- (CGFloat) angleOfVertex:(NSPoint)vertex
+{
+    // The angle from the start of the run to the vertex, relative to the direction of the first line
+    NSPoint offset = FBSubtractPoint(vertex, _curve.endPoint1);
+    CGFloat cross = _referenceDirection.x * offset.y - _referenceDirection.y * offset.x;
+    return atan2(cross, FBDotMultiplyPoint(_referenceDirection, offset));
+}
+
+- (void) constrainDirectionsWithVertex:(NSPoint)vertex
+{
+    // A vertex some distance from the start is within tolerance of a line from the start only
+    //  if the line's direction is within asin(tolerance / distance) of the vertex's direction.
+    CGFloat distance = FBDistanceBetweenPoints(_curve.endPoint1, vertex);
+    _farthestDistance = MAX(_farthestDistance, distance);
+    if ( distance <= _tolerance )
+        return; // close enough to the start to be near any line through it
+    CGFloat angle = [self angleOfVertex:vertex];
+    CGFloat spread = asin(_tolerance / distance);
+    _minimumAngle = MAX(_minimumAngle, angle - spread);
+    _maximumAngle = MIN(_maximumAngle, angle + spread);
+}
+
+- (BOOL) appendCurve:(FBBezierCurve *)curve
+{
+    // Add the curve to the end of the run, if one curve can replace the run and it.
+    CGFloat parameter = 0.0;
+    FBBezierCurve *joinedCurve = [_curve curveJoinedWithCurve:curve tolerance:_tolerance parameter:&parameter];
+    if ( joinedCurve == nil )
+        return NO;
+    
+    if ( _curve.isStraightLine ) {
+        // The new end has to keep going away from the start, so every vertex so far projects onto the
+        //  joined line, and the line has to head in a direction that's near all of them.
+        if ( FBDistanceBetweenPoints(_curve.endPoint1, curve.endPoint2) < _farthestDistance )
+            return NO;
+        CGFloat angle = [self angleOfVertex:curve.endPoint2];
+        if ( angle < _minimumAngle || angle > _maximumAngle )
+            return NO;
+        [self constrainDirectionsWithVertex:curve.endPoint2];
+    } else {
+        // Joining only verifies against the curve so far, which can drift. Anchor it to the first piece.
+        FBRange firstPieceRange = FBRangeMake(0.0, _firstPieceRange.maximum * parameter);
+        if ( ![joinedCurve matchesCurve:[_pieces objectAtIndex:0] inRange:firstPieceRange tolerance:_tolerance] )
+            return NO;
+        _firstPieceRange = firstPieceRange;
+    }
+    
+    [_curve release];
+    _curve = [joinedCurve retain];
+    [_pieces addObject:curve];
+    [_parameters addObject:[NSNumber numberWithDouble:parameter]];
+    return YES;
+}
+
+- (NSArray *) simplifiedCurves
+{
+    // Lines were checked against every vertex as they were added, so they're done
+    if ( [_pieces count] == 1 || _curve.isStraightLine )
+        return [NSArray arrayWithObject:_curve];
+    
+    // Work backwards to find where each piece falls on the final curve. Each piece started at its
+    //  parameter on the curve it was joined onto, and every later join scaled that down.
+    CGFloat scale = 1.0;
+    for (NSUInteger i = [_pieces count] - 1; i > 0; i--) {
+        CGFloat parameter = [[_parameters objectAtIndex:i - 1] doubleValue];
+        FBRange range = FBRangeMake(parameter * scale, scale);
+        if ( ![_curve matchesCurve:[_pieces objectAtIndex:i] inRange:range tolerance:_tolerance] )
+            return _pieces; // something drifted, so keep the pieces as they were
+        scale *= parameter;
+    }
+    
+    return [NSArray arrayWithObject:_curve];
+}
+
+@end
+
 @implementation FBBezierContour
 
 @synthesize edges=_edges;
@@ -350,6 +503,61 @@
 }
 
 
+- (FBBezierContour *) simplifiedContourWithTolerance:(CGFloat)tolerance
+{
+    // Boolean operations split edges at every crossing, and the pieces stay split in the result.
+    //  Build a copy of ourself with degenerate edges dropped, and neighboring edges joined back
+    //  together wherever one curve can replace them within the tolerance.
+    //  An edge only counts as degenerate if it stays within tolerance of where the last kept curve
+    //  ended, so a string of short edges can't add up to a gap wider than the tolerance.
+    NSMutableArray *curves = [NSMutableArray arrayWithCapacity:[_edges count]];
+    NSPoint lastPoint = self.firstPoint;
+    for (FBContourEdge *edge in _edges) {
+        if ( [edge.curve isWithinDistance:tolerance ofPoint:lastPoint] )
+            continue;
+        lastPoint = edge.curve.endPoint2;
+        [curves addObject:edge.curve];
+    }
+    
+    // The contour is closed, so start at a curve that can't be joined onto the one before it.
+    //  That way no run has to wrap around from the last curve to the first.
+    NSUInteger curveCount = [curves count];
+    NSUInteger startIndex = 0;
+    for (NSUInteger i = 0; i < curveCount; i++) {
+        FBBezierCurve *previousCurve = [curves objectAtIndex:(i + curveCount - 1) % curveCount];
+        if ( [previousCurve curveJoinedWithCurve:[curves objectAtIndex:i] tolerance:tolerance] == nil ) {
+            startIndex = i;
+            break;
+        }
+    }
+    
+    NSMutableArray *runs = [NSMutableArray arrayWithCapacity:curveCount];
+    for (NSUInteger i = 0; i < curveCount; i++) {
+        FBBezierCurve *curve = [curves objectAtIndex:(startIndex + i) % curveCount];
+        if ( ![[runs lastObject] appendCurve:curve] )
+            [runs addObject:[FBCurveRun curveRunWithCurve:curve tolerance:tolerance]];
+    }
+    
+    NSMutableArray *simplifiedCurves = [NSMutableArray arrayWithCapacity:[runs count]];
+    for (FBCurveRun *run in runs)
+        [simplifiedCurves addObjectsFromArray:[run simplifiedCurves]];
+    
+    // Dropping degenerate edges, or joining curves whose ends were only close, can leave small
+    //  gaps. Snap each curve's start to the previous curve's end so the contour stays continuous.
+    FBBezierContour *simplifiedContour = [[[[self class] alloc] init] autorelease];
+    FBBezierCurve *previousCurve = [simplifiedCurves lastObject];
+    for (FBBezierCurve *curve in simplifiedCurves) {
+        FBBezierCurve *snappedCurve = curve;
+        if ( FBDistanceBetweenPoints(curve.endPoint1, previousCurve.endPoint2) <= tolerance )
+            snappedCurve = FBCurveWithStartPoint(curve, previousCurve.endPoint2);
+        [simplifiedContour addCurve:snappedCurve];
+        previousCurve = snappedCurve;
+    }
+    simplifiedContour.inside = _inside;
+    
+    return simplifiedContour;
+}
+
 - (NSArray *) intersectingContours
 {
     // Go and find all the unique contours that intersect this specific contour
@@ -48,6 +48,13 @@
 
 - (FBBezierCurve *) reversedCurve;	// GPC: added
 
+// Used to compact output. Tolerances are distances between points, in the same units as the curve.
+//  Joining returns nil if the two curves can't be replaced by one curve within tolerance.
+- (BOOL) isWithinDistance:(CGFloat)distance ofPoint:(NSPoint)point;
+- (FBBezierCurve *) curveJoinedWithCurve:(FBBezierCurve *)curve tolerance:(CGFloat)tolerance;
+- (FBBezierCurve *) curveJoinedWithCurve:(FBBezierCurve *)curve tolerance:(CGFloat)tolerance parameter:(CGFloat *)parameter;
+- (BOOL) matchesCurve:(FBBezierCurve *)curve inRange:(FBRange)range tolerance:(CGFloat)tolerance;
+
 - (NSBezierPath *) bezierPath;
 
 @end
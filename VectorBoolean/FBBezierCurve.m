@@ -12,6 +12,8 @@
 #import "FBBezierIntersection.h"
 #import "FBBezierIntersectRange.h"
 
+extern const CGFloat FBParameterCloseThreshold;
+
 //////////////////////////////////////////////////////////////////////////////////
 // Normalized lines
 //
@@ -969,6 +971,107 @@ static CGFloat FBGaussQuadratureComputeCurveLengthForCubic(CGFloat z, NSUInteger
         && FBArePointsCloseWithOptions(_endPoint1, _controlPoint2, FBClosenessThreshold);
 }
 
+- (BOOL) isWithinDistance:(CGFloat)distance ofPoint:(NSPoint)point
+{
+    // The curve lies inside the convex hull of its points, so if they're all close, so is the curve
+    return FBDistanceBetweenPoints(_endPoint1, point) <= distance
+        && FBDistanceBetweenPoints(_controlPoint1, point) <= distance
+        && FBDistanceBetweenPoints(_controlPoint2, point) <= distance
+        && FBDistanceBetweenPoints(_endPoint2, point) <= distance;
+}
+
+- (FBBezierCurve *) curveJoinedWithCurve:(FBBezierCurve *)curve tolerance:(CGFloat)tolerance
+{
+    return [self curveJoinedWithCurve:curve tolerance:tolerance parameter:nil];
+}
+
+- (FBBezierCurve *) curveJoinedWithCurve:(FBBezierCurve *)curve tolerance:(CGFloat)tolerance parameter:(CGFloat *)parameter
+{
+    // Attempt to replace us followed by the given curve with one curve. This only succeeds
+    //  if the two curves meet, and the result traces the same path within tolerance. On success,
+    //  parameter is where we end, and the given curve starts, on the joined curve.
+    if ( FBDistanceBetweenPoints(_endPoint2, curve.endPoint1) > tolerance )
+        return nil;
+    
+    if ( self.isStraightLine || curve.isStraightLine ) {
+        // Lines can only be joined with lines. They have to be colinear, and keep going in the
+        //  same direction. (Otherwise we'd be removing a spike.)
+        if ( !self.isStraightLine || !curve.isStraightLine )
+            return nil;
+        NSPoint direction1 = FBSubtractPoint(_endPoint2, _endPoint1);
+        NSPoint direction2 = FBSubtractPoint(curve.endPoint2, curve.endPoint1);
+        if ( FBDotMultiplyPoint(direction1, direction2) <= 0.0 )
+            return nil;
+        if ( FBDistancePointToLine(_endPoint2, _endPoint1, curve.endPoint2) > tolerance )
+            return nil;
+        if ( parameter != nil ) {
+            // Lines are parameterized by length, so project our end point onto the joined line
+            NSPoint joinedDirection = FBSubtractPoint(curve.endPoint2, _endPoint1);
+            *parameter = FBDotMultiplyPoint(direction1, joinedDirection) / FBPointSquaredLength(joinedDirection);
+        }
+        return [FBBezierCurve bezierCurveWithLineStartPoint:_endPoint1 endPoint:curve.endPoint2];
+    }
+    
+    // For cubics, assume we're the left half, and the curve is the right half, of an original
+    //  curve split at some parameter t. The de Casteljau construction puts the split point on the
+    //  line between our second control point and the curve's first control point, at t of the way
+    //  along. That gives us t, from which we can recover the original control points.
+    NSPoint tangentStart = _controlPoint2;
+    NSPoint tangentEnd = curve.controlPoint1;
+    CGFloat tangentLength = FBDistanceBetweenPoints(tangentStart, tangentEnd);
+    if ( tangentLength == 0.0 )
+        return nil;
+    if ( FBDistancePointToLine(_endPoint2, tangentStart, tangentEnd) > tolerance )
+        return nil;
+    CGFloat splitParameter = FBDistanceBetweenPoints(tangentStart, _endPoint2) / tangentLength;
+    
+    // Recovering the control points divides by t and 1 - t, which magnifies any error in the
+    //  pieces by up to 1/t. Splits that close to an end aren't worth the risk, so leave them be.
+    if ( splitParameter <= FBParameterCloseThreshold || splitParameter >= (1.0 - FBParameterCloseThreshold) )
+        return nil;
+    
+    NSPoint controlPoint1 = FBAddPoint(_endPoint1, FBScalePoint(FBSubtractPoint(_controlPoint1, _endPoint1), 1.0 / splitParameter));
+    NSPoint controlPoint2 = FBAddPoint(curve.endPoint2, FBScalePoint(FBSubtractPoint(curve.controlPoint2, curve.endPoint2), 1.0 / (1.0 - splitParameter)));
+    FBBezierCurve *joinedCurve = [FBBezierCurve bezierCurveWithEndPoint1:_endPoint1 controlPoint1:controlPoint1 controlPoint2:controlPoint2 endPoint2:curve.endPoint2];
+    
+    // Verify the guess by splitting it back apart and seeing if we get the same two curves
+    if ( ![joinedCurve matchesCurve:self inRange:FBRangeMake(0.0, splitParameter) tolerance:tolerance] )
+        return nil;
+    if ( ![joinedCurve matchesCurve:curve inRange:FBRangeMake(splitParameter, 1.0) tolerance:tolerance] )
+        return nil;
+    
+    if ( parameter != nil )
+        *parameter = splitParameter;
+    return joinedCurve;
+}
+
+- (BOOL) matchesCurve:(FBBezierCurve *)curve inRange:(FBRange)range tolerance:(CGFloat)tolerance
+{
+    // Determine if the given curve is the piece of us over the parameter range.
+    if ( self.isStraightLine ) {
+        // Lines are parameterized by length, so the curve's ends have to be near the points at either end
+        //  of the range. That keeps them on us, and between our end points. The control points don't
+        //  matter since lines are output as line tos.
+        if ( !curve.isStraightLine )
+            return NO;
+        NSPoint direction = FBSubtractPoint(_endPoint2, _endPoint1);
+        NSPoint rangeStart = FBAddPoint(_endPoint1, FBScalePoint(direction, range.minimum));
+        NSPoint rangeEnd = FBAddPoint(_endPoint1, FBScalePoint(direction, range.maximum));
+        return FBDistanceBetweenPoints(curve.endPoint1, rangeStart) <= tolerance
+            && FBDistanceBetweenPoints(curve.endPoint2, rangeEnd) <= tolerance;
+    }
+    if ( curve.isStraightLine )
+        return NO;
+    
+    // A bezier curve lies inside the convex hull of its points, so if all the points of the difference
+    //  between two curves are within tolerance of zero, so is every point along the curves.
+    FBBezierCurve *subcurve = [self subcurveWithRange:range];
+    return FBDistanceBetweenPoints(subcurve.endPoint1, curve.endPoint1) <= tolerance
+        && FBDistanceBetweenPoints(subcurve.controlPoint1, curve.controlPoint1) <= tolerance
+        && FBDistanceBetweenPoints(subcurve.controlPoint2, curve.controlPoint2) <= tolerance
+        && FBDistanceBetweenPoints(subcurve.endPoint2, curve.endPoint2) <= tolerance;
+}
+
 - (NSRect) bounds
 {    
     // Start with the end points
@@ -28,6 +28,12 @@
 - (FBBezierGraph *) differenceWithBezierGraph:(FBBezierGraph *)graph;
 - (FBBezierGraph *) xorWithBezierGraph:(FBBezierGraph *)graph;
 
+// Returns a copy with zero length edges removed, and neighboring edges merged back together
+//  where possible (colinear lines, or pieces of the same split curve). Boolean results can
+//  be simplified before being fed into another boolean operation to keep edge counts down.
+//  The tolerance is the farthest, in path units, any part of the result may move.
+- (FBBezierGraph *) simplifiedBezierGraphWithTolerance:(CGFloat)tolerance;
+
 - (NSBezierPath *) bezierPath;
 
 @property (readonly) NSArray* contours;
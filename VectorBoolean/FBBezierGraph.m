@@ -501,6 +501,19 @@
     return [allParts differenceWithBezierGraph:intersectingParts];
 }
 
+- (FBBezierGraph *) simplifiedBezierGraphWithTolerance:(CGFloat)tolerance
+{
+    // Simplify each contour independently. Contours that were nothing but degenerate
+    //  edges are dropped altogether.
+    FBBezierGraph *result = [FBBezierGraph bezierGraph];
+    for (FBBezierContour *contour in _contours) {
+        FBBezierContour *simplifiedContour = [contour simplifiedContourWithTolerance:tolerance];
+        if ( [simplifiedContour.edges count] > 0 )
+            [result addContour:simplifiedContour];
+    }
+    return result;
+}
+
 - (NSBezierPath *) bezierPath
 {
     // Convert this graph into a bezier path. This is straightforward, each contour